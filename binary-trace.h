@@ -0,0 +1,47 @@
+#ifndef BINARY_TRACE_H
+#define BINARY_TRACE_H
+
+#include <cstdint>
+
+/*
+   File written by dumbbell.cc --binaryTrace and read back by
+   binary-trace-render.cc: one BinaryTraceHeader, then one fixed-width
+   BinaryTraceRecord per device event.
+*/
+
+const char BINARY_TRACE_MAGIC[8] = {'N', '3', 'B', 'T', 'R', 'A', 'C', 'E'};
+const uint32_t BINARY_TRACE_VERSION = 1;
+
+struct BinaryTraceHeader
+{
+    char magic[8]; // BINARY_TRACE_MAGIC
+    uint32_t version;
+    uint32_t recordSize; // sizeof(BinaryTraceRecord)
+};
+
+// Event codes. The renderer prints AsciiTraceHelper's letter for each (both
+// drops are 'd') along with the trace source it came from.
+enum BinaryTraceEvent : char
+{
+    BTR_ENQUEUE = '+',     // TxQueue/Enqueue
+    BTR_DEQUEUE = '-',     // TxQueue/Dequeue
+    BTR_QUEUE_DROP = 'd',  // TxQueue/Drop
+    BTR_PHY_RX_DROP = 'D', // PhyRxDrop
+    BTR_RECEIVE = 'r',     // MacRx
+};
+
+struct BinaryTraceRecord
+{
+    int64_t time;    // simulation time in nanoseconds
+    uint64_t uid;    // Packet::GetUid(), identifies the packet across hops
+    uint32_t node;
+    uint32_t device;
+    uint32_t size;
+    char event; // BinaryTraceEvent
+    char padding[3];
+};
+
+static_assert(sizeof(BinaryTraceHeader) == 16, "BinaryTraceHeader layout is part of the file format");
+static_assert(sizeof(BinaryTraceRecord) == 32, "BinaryTraceRecord layout is part of the file format");
+
+#endif /* BINARY_TRACE_H */
@@ -26,6 +26,20 @@ NS_LOG_COMPONENT_DEFINE("Csma");
 
 int nLeftNode = 10;
 double operationTime = 20;
+bool staticArp = false;
+
+Ptr<PacketSink> sink[10];
+
+void
+PrintAverageThroughput(void)
+{
+    for (int i = 0; i < 10; i++)
+    {
+        uint64_t currentTotalRx = sink[i]->GetTotalRx();
+        double currentThroughput = (currentTotalRx * 8) / (operationTime * 1e6);
+        std::cout << i + 10 << " " << currentThroughput << " Mbits" << std::endl;
+    }
+}
 
 int
 main(int argc, char* argv[])
@@ -33,6 +47,7 @@ main(int argc, char* argv[])
     CommandLine cmd(__FILE__);
     cmd.AddValue("nLeftNode", "number of left side node", nLeftNode);
     cmd.AddValue("operationTime", "time value where application sends packet in second", operationTime);
+    cmd.AddValue("staticArp", "Pre-populate ARP caches instead of resolving at run time", staticArp);
     cmd.Parse(argc, argv);
 
     Time::SetResolution(Time::NS);
@@ -44,7 +59,17 @@ main(int argc, char* argv[])
     routers[1].Add(routers[0].Get(1));
     routers[1].Create(1);
 
-    //여기까지 함
+    // Every left node and R1 share one CSMA segment.
+    NodeContainer lanNodes;
+    lanNodes.Add(leftNodes);
+    lanNodes.Add(routers[0].Get(0));
+
+    CsmaHelper lan;
+    lan.SetChannelAttribute("DataRate", StringValue("100Mbps"));
+    lan.SetChannelAttribute("Delay", StringValue("2us"));
+    lan.SetQueue("ns3::DropTailQueue", "MaxSize", StringValue("300p"));
+
+    NetDeviceContainer lanDevices = lan.Install(lanNodes);
 
     PointToPointHelper gateway;
     gateway.SetDeviceAttribute("DataRate", StringValue("100Mbps"));
@@ -52,12 +77,9 @@ main(int argc, char* argv[])
     gateway.DisableFlowControl();
     gateway.SetQueue("ns3::DropTailQueue", "MaxSize", StringValue("300p"));
 
-    NetDeviceContainer leftNodeDevices, leftRouterDevices, rightNodeDevices, rightRouterDevices;
+    NetDeviceContainer rightNodeDevices, rightRouterDevices;
     for (int i = 0; i < 10; i++)
     {
-        NetDeviceContainer left = gateway.Install(leftNodes.Get(i), routers[0].Get(0));
-        leftNodeDevices.Add(left.Get(0));
-        leftRouterDevices.Add(left.Get(1));
         NetDeviceContainer right = gateway.Install(rightNodes.Get(i), routers[1].Get(1));
         rightNodeDevices.Add(right.Get(0));
         rightRouterDevices.Add(right.Get(1));
@@ -67,10 +89,7 @@ main(int argc, char* argv[])
     bottleneck.SetDeviceAttribute("DataRate", StringValue("300Mbps"));
     bottleneck.SetChannelAttribute("Delay", StringValue("10ms"));
     bottleneck.DisableFlowControl();
-    if (enableRED)
-        bottleneck.SetQueue("ns3::DropTailQueue", "MaxSize", StringValue("300p"));
-    else
-        bottleneck.SetQueue("ns3::DropTailQueue", "MaxSize", StringValue("1000p"));
+    bottleneck.SetQueue("ns3::DropTailQueue", "MaxSize", StringValue("1000p"));
  
     NetDeviceContainer routerDevices[2];
     routerDevices[0] = bottleneck.Install(routers[0]);
@@ -82,37 +101,10 @@ main(int argc, char* argv[])
     stack.Install(routers[0]);
     stack.Install(routers[1].Get(1));
 
-    if (enableRED)
-    {
-        Ptr<PointToPointNetDevice> devA = StaticCast<PointToPointNetDevice>(routerDevices[0].Get(0));
-        Ptr<Queue<Packet>> queueA = devA->GetQueue();
-
-        Ptr<NetDeviceQueueInterface> ndqiA = CreateObject<NetDeviceQueueInterface>();
-        ndqiA->GetTxQueue(0)->ConnectQueueTraces(queueA);
-        devA->AggregateObject(ndqiA);
-
-        TrafficControlHelper tch;
-        tch.SetRootQueueDisc("ns3::RedQueueDisc", "MaxSize", StringValue("700p"), "LinkBandwidth", StringValue("300Mbps"), "LinkDelay", StringValue("10ms"));
-        tch.Install(routerDevices[0].Get(0));
-
-        Config::ConnectWithoutContext("/NodeList/20/$ns3::Node/$ns3::TrafficControlLayer/RootQueueDiscList/10/$ns3::RedQueueDisc/Drop", MakeCallback(&Drop));
-        Config::ConnectWithoutContext("/NodeList/20/$ns3::Node/$ns3::TrafficControlLayer/RootQueueDiscList/10/$ns3::RedQueueDisc/DropBeforeEnqueue", MakeCallback(&DropBeforeEnqueue));
-        Config::ConnectWithoutContext("/NodeList/20/$ns3::Node/$ns3::TrafficControlLayer/RootQueueDiscList/10/$ns3::RedQueueDisc/DropAfterDequeue", MakeCallback(&DropAfterDequeue));
-    }
-
+    // A /16 so the LAN can hold hundreds of hosts.
     Ipv4AddressHelper address;
-    address.SetBase("10.1.1.0", "255.255.255.0");
-    Ipv4InterfaceContainer leftNodeInterfaces, leftRouterInterfaces;
-    for (int i = 0; i < 10; i++)
-    {
-        NetDeviceContainer ndc;
-        ndc.Add(leftNodeDevices.Get(i));
-        ndc.Add(leftRouterDevices.Get(i));
-        Ipv4InterfaceContainer ifc = address.Assign(ndc);
-        leftNodeInterfaces.Add(ifc.Get(0));
-        leftRouterInterfaces.Add(ifc.Get(1));
-        address.NewNetwork();
-    }
+    address.SetBase("10.1.0.0", "255.255.0.0");
+    Ipv4InterfaceContainer lanInterfaces = address.Assign(lanDevices);
 
     address.SetBase("10.2.1.0", "255.255.255.0");
     Ipv4InterfaceContainer rightNodeIterfaces, rightRouterInterfaces;
@@ -133,6 +125,13 @@ main(int argc, char* argv[])
     address.SetBase("10.4.1.0", "255.255.255.0");
     routerInterfaces[1] = address.Assign(routerDevices[1]);
 
+    // Avoids one broadcast ARP exchange per LAN host before traffic starts.
+    if (staticArp)
+    {
+        NeighborCacheHelper neighborCache;
+        neighborCache.PopulateNeighborCache();
+    }
+
     uint16_t sinkPort = 8080;
     PacketSinkHelper packetSinkHelper("ns3::TcpSocketFactory", InetSocketAddress(Ipv4Address::GetAny(), sinkPort));
     for (int i = 0; i < 10; i++)
@@ -141,8 +140,12 @@ main(int argc, char* argv[])
         sinkApps.Start(Seconds(1.0));
         sinkApps.Stop(Seconds(operationTime + 1.0));
         sink[i] = StaticCast<PacketSink>(sinkApps.Get(0));
+    }
 
-        BulkSendHelper source("ns3::TcpSocketFactory", InetSocketAddress(rightNodeIterfaces.GetAddress(i), sinkPort));
+    // Left node i sends to right node i % 10.
+    for (int i = 0; i < nLeftNode; i++)
+    {
+        BulkSendHelper source("ns3::TcpSocketFactory", InetSocketAddress(rightNodeIterfaces.GetAddress(i % 10), sinkPort));
         ApplicationContainer sourceApps = source.Install(leftNodes.Get(i));
         sourceApps.Start(Seconds(1.0));
         sourceApps.Stop(Seconds(operationTime + 1.0));
@@ -207,37 +210,11 @@ main(int argc, char* argv[])
     AnimationInterface anim("dumbbell.xml");
 */
 
-    R1Queue = StaticCast<Queue<Packet>>(StaticCast<PointToPointNetDevice>(routerDevices[0].Get(0))->GetQueue());
-
-/*
-    gateway.EnableAsciiAll(asciiTraceHelper.CreateFileStream("dumbbell.tr"));
-    gateway.EnablePcap("dumbbell", leftNodeDevices.Get(0), false);
-*/
-
-    Simulator::Schedule(Seconds(1.000000001), &AddTracer);
-    //Simulator::Schedule(Seconds(1.1), &CalculateThroughput);
     Simulator::Stop(Seconds(operationTime + 1.0));
 
-/*
-    Config::SetDefault("ns3::ConfigStore::Filename", StringValue("output-attributes.txt"));
-    Config::SetDefault("ns3::ConfigStore::FileFormat", StringValue("RawText"));
-    Config::SetDefault("ns3::ConfigStore::Mode", StringValue("Save"));
-    ConfigStore outputConfig2;
-    outputConfig2.ConfigureAttributes();
-*/
-
     Simulator::Run();
     Simulator::Destroy();
 
-    if (enableRED) {
-        std::cout << "Drop: " << drop << std::endl;
-        std::cout << "DropBeforeEnqueue: " << dropBeforeEnqueue << std::endl;
-        std::cout << "DropAfterDequeue: " << dropAfterDequeue << std::endl;
-    }
-    else {
-        std::cout << "Drop: " << R1Queue->GetTotalDroppedPackets() << std::endl;
-    }
-
     PrintAverageThroughput();
 
     return 0;
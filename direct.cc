@@ -53,11 +53,13 @@ PacketDrop(Ptr<const Packet> p)
 {
     count++;
     Time now = Simulator::Now();
-    Ptr<Packet> copy = p->Copy();
-    Ipv4Header iph;
-    copy->RemoveHeader(iph);
+    // A dropped TxQueue packet starts with the 2-byte PPP header, followed by the
+    // IPv4 header whose source address sits at offset 12. Read just those bytes
+    // instead of copying the packet and deserializing a full Ipv4Header.
+    uint8_t frame[22];
+    p->CopyData(frame, sizeof(frame));
     std::cout << now.GetSeconds() << " ";
-    iph.GetSource().Print(std::cout);
+    Ipv4Address::Deserialize(frame + 14).Print(std::cout);
     std::cout << " " << count << std::endl;
 }
 
@@ -116,16 +118,25 @@ main(int argc, char* argv[])
 
     int operationTime = 10;
     bool enableRED = false;
+    bool logging = false;
 
     CommandLine cmd(__FILE__);
     cmd.AddValue("operationTime", "time value where application sends packet in second", operationTime);
     cmd.AddValue("RED", "Enable RED policy", enableRED);
+    cmd.AddValue("logging", "Enable INFO logging of TCP, BulkSend and DropTailQueue", logging);
     cmd.Parse(argc, argv);
  
     Time::SetResolution(Time::NS);
-    //LogComponentEnable("TcpSocketBase", LOG_LEVEL_INFO);
-    //LogComponentEnable("BulkSendApplication", LOG_LEVEL_INFO);
-    //LogComponentEnable("DropTailQueue", LOG_LEVEL_INFO);
+    if (logging)
+    {
+#ifdef NS3_LOG_ENABLE
+        LogComponentEnable("TcpSocketBase", LOG_LEVEL_INFO);
+        LogComponentEnable("BulkSendApplication", LOG_LEVEL_INFO);
+        LogComponentEnable("DropTailQueue", LOG_LEVEL_INFO);
+#else
+        std::cout << "logging requested, but ns-3 was built without NS3_LOG_ENABLE" << std::endl;
+#endif
+    }
 
     NodeContainer leftNodes, rightNodes, routers[2];
     leftNodes.Create(10);
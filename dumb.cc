@@ -33,11 +33,11 @@ DropTracer(Ptr<const Packet> p)
 {
     count++;
     Time now = Simulator::Now();
-    Ptr<Packet> copy = p->Copy();
-    Ipv4Header iph;
-    copy->RemoveHeader(iph);
+    // PPP header (2 bytes) + IPv4 source address at offset 12 of the IPv4 header.
+    uint8_t frame[22];
+    p->CopyData(frame, sizeof(frame));
     std::cout << now.GetSeconds() << " ";
-    iph.GetSource().Print(std::cout);
+    Ipv4Address::Deserialize(frame + 14).Print(std::cout);
     std::cout << " " << count << std::endl;
 }
 
@@ -0,0 +1,116 @@
+#include "live-metrics.h"
+
+#include "ns3/core-module.h"
+
+#include <cerrno>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/*
+   Follows a run started with dumbbell --liveMetrics=<file> and prints its
+   progress, event rate, aggregate goodput, R1 queue length and ETA until the
+   run finishes.
+*/
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("LiveMetricsReader");
+
+int
+main(int argc, char* argv[])
+{
+    std::string input = "/dev/shm/dumbbell-metrics";
+    double interval = 1.0;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("input", "file given to dumbbell --liveMetrics", input);
+    cmd.AddValue("interval", "seconds between progress lines", interval);
+    cmd.Parse(argc, argv);
+
+    int fd = open(input.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        std::cerr << "cannot open " << input << std::endl;
+        return 1;
+    }
+    void* mem = mmap(nullptr, sizeof(LiveMetrics), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mem == MAP_FAILED)
+    {
+        std::cerr << "cannot map " << input << std::endl;
+        return 1;
+    }
+    const LiveMetrics* metrics = static_cast<const LiveMetrics*>(mem);
+    if (metrics->magic != LIVE_METRICS_MAGIC)
+    {
+        std::cerr << input << " is not a dumbbell metrics file" << std::endl;
+        return 1;
+    }
+
+    double lastWallTime = 0;
+    double lastSimTime = 0;
+    while (true)
+    {
+        bool finished = metrics->finished.load(std::memory_order_acquire);
+        uint64_t head = metrics->head.load(std::memory_order_acquire);
+
+        // Snapshots are paced by simulated time, so a long gap does not mean
+        // the run is gone; a simulator that died never sets finished, though,
+        // and its pid no longer exists.
+        // finished is read again in case the run ended after the first load.
+        if (!finished && kill(metrics->pid, 0) != 0 && errno == ESRCH &&
+            !metrics->finished.load(std::memory_order_acquire))
+        {
+            std::cerr << "simulator (pid " << metrics->pid << ") exited without finishing" << std::endl;
+            munmap(mem, sizeof(LiveMetrics));
+            return 1;
+        }
+        if (head > 0)
+        {
+            const LiveMetricsSnapshot& slot = metrics->slots[(head - 1) % LIVE_METRICS_SLOTS];
+            uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+            double wallTime = slot.wallTime;
+            double simTime = slot.simTime;
+            double eventsPerSecond = slot.eventsPerSecond;
+            uint32_t queue = slot.queue;
+            double goodput = 0;
+            for (uint32_t i = 0; i < LIVE_METRICS_FLOWS; i++)
+            {
+                goodput += slot.goodput[i];
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            // Skip a snapshot the simulator overwrote while it was being read.
+            if (sequence == head && slot.sequence.load(std::memory_order_relaxed) == head)
+            {
+                double progress = 100 * simTime / metrics->stopTime;
+                std::cout << "sim " << simTime << "/" << metrics->stopTime << " s (" << progress
+                          << "%)  " << eventsPerSecond << " events/s  goodput " << goodput
+                          << " Mbits  queue " << queue << " p";
+                if (wallTime > lastWallTime && simTime > lastSimTime)
+                {
+                    double speed = (simTime - lastSimTime) / (wallTime - lastWallTime);
+                    std::cout << "  ETA " << (metrics->stopTime - simTime) / speed << " s";
+                }
+                std::cout << std::endl;
+                lastWallTime = wallTime;
+                lastSimTime = simTime;
+            }
+        }
+
+        if (finished)
+        {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::duration<double>(interval));
+    }
+
+    munmap(mem, sizeof(LiveMetrics));
+    return 0;
+}
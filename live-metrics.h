@@ -0,0 +1,48 @@
+#ifndef LIVE_METRICS_H
+#define LIVE_METRICS_H
+
+#include <atomic>
+#include <cstdint>
+
+/*
+   Layout of the memory-mapped file that dumbbell.cc --liveMetrics publishes
+   into and live-metrics-reader.cc reads. The simulator only stores into the
+   mapping, so publishing a snapshot costs no system call.
+
+   Snapshots form a ring. A slot's sequence is 0 while the simulator writes
+   it and head (the number of snapshots published) once it is complete, so a
+   reader can tell whether the slot changed under it.
+
+   The simulator's pid lets a reader tell a slow run from one that died
+   before setting finished.
+*/
+
+const uint64_t LIVE_METRICS_MAGIC = 0x4c4956454d455432ULL; // "LIVEMET2"
+const uint32_t LIVE_METRICS_FLOWS = 10;
+const uint32_t LIVE_METRICS_SLOTS = 64;
+
+struct LiveMetricsSnapshot
+{
+    std::atomic<uint64_t> sequence;
+    double wallTime; // seconds since the run was set up
+    double simTime;  // seconds
+    uint64_t events;
+    double eventsPerSecond;
+    uint32_t queue; // packets queued at R1's bottleneck device plus its RED queue disc
+    uint32_t cwnd[LIVE_METRICS_FLOWS];
+    double goodput[LIVE_METRICS_FLOWS]; // Mbits/s over the last publish interval
+};
+
+struct LiveMetrics
+{
+    uint64_t magic;
+    double stopTime;
+    int64_t pid; // of the simulator process
+    std::atomic<uint64_t> head;
+    std::atomic<uint32_t> finished;
+    LiveMetricsSnapshot slots[LIVE_METRICS_SLOTS];
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "the ring is shared between processes");
+
+#endif /* LIVE_METRICS_H */
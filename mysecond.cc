@@ -38,10 +38,16 @@ main(int argc, char* argv[])
 {
     bool verbose = true;
     uint32_t nCsma = 3;
+    bool staticArp = false;
+    bool tracing = true;
+    uint32_t snapLen = 65535;
  
     CommandLine cmd(__FILE__);
     cmd.AddValue("nCsma", "Number of \"extra\" CSMA nodes/devices", nCsma);
     cmd.AddValue("verbose", "Tell echo applications to log if true", verbose);
+    cmd.AddValue("staticArp", "Pre-populate ARP caches instead of resolving at run time", staticArp);
+    cmd.AddValue("tracing", "Enable pcap tracing", tracing);
+    cmd.AddValue("snapLen", "Maximum number of bytes captured per packet", snapLen);
  
     cmd.Parse(argc, argv);
  
@@ -86,6 +92,14 @@ main(int argc, char* argv[])
     address.SetBase("10.1.2.0", "255.255.255.0");
     Ipv4InterfaceContainer csmaInterfaces;
     csmaInterfaces = address.Assign(csmaDevices);
+
+    // Fill every ArpCache with permanent entries so the first echo packet is
+    // not preceded by the ARP request/reply exchange traced below.
+    if (staticArp)
+    {
+        NeighborCacheHelper neighborCache;
+        neighborCache.PopulateNeighborCache();
+    }
  
     UdpEchoServerHelper echoServer(9);
  
@@ -104,8 +118,21 @@ main(int argc, char* argv[])
  
     Ipv4GlobalRoutingHelper::PopulateRoutingTables();
  
-    pointToPoint.EnablePcapAll("second");
-    csma.EnablePcap("second", csmaDevices.Get(1), true);
+    if (tracing)
+    {
+        // Both ends of the point-to-point link share one capture file. PhyTxBegin
+        // only fires on the sending device, so every frame is written once, and
+        // it is cut to snapLen before its bytes are copied out.
+        PcapHelper pcapHelper;
+        Ptr<PcapFileWrapper> p2pFile =
+            pcapHelper.CreateFile("second-p2p.pcap", std::ios::out, PcapHelper::DLT_PPP, snapLen);
+        for (uint32_t i = 0; i < p2pDevices.GetN(); i++)
+        {
+            Ptr<PointToPointNetDevice> device = StaticCast<PointToPointNetDevice>(p2pDevices.Get(i));
+            pcapHelper.HookDefaultSink<PointToPointNetDevice>(device, "PhyTxBegin", p2pFile);
+        }
+        csma.EnablePcap("second", csmaDevices.Get(1), true);
+    }
  
     Simulator::Run();
     Simulator::Destroy();
@@ -23,6 +23,9 @@
 #include "ns3/ssid.h"
 #include "ns3/yans-wifi-helper.h"
 
+#include <algorithm>
+#include <cmath>
+
 // Default Network Topology
 //
 //   Wifi 10.1.3.0
@@ -53,23 +56,30 @@ main(int argc, char* argv[])
     uint32_t nCsma = 3;
     uint32_t nWifi = 3;
     bool tracing = false;
+    uint32_t snapLen = 65535;
+    double maxRange = 0;
+    bool traceMobility = true;
 
     CommandLine cmd(__FILE__);
     cmd.AddValue("nCsma", "Number of \"extra\" CSMA nodes/devices", nCsma);
     cmd.AddValue("nWifi", "Number of wifi STA devices", nWifi);
     cmd.AddValue("verbose", "Tell echo applications to log if true", verbose);
     cmd.AddValue("tracing", "Enable pcap tracing", tracing);
+    cmd.AddValue("snapLen", "Maximum number of bytes captured per packet", snapLen);
+    cmd.AddValue("maxRange", "Hard radio range in meters on top of the default loss model (0 = none)", maxRange);
+    cmd.AddValue("traceMobility", "Log every CourseChange of the echo client STA", traceMobility);
 
     cmd.Parse(argc, argv);
 
-    // The underlying restriction of 18 is due to the grid position
-    // allocator's configuration; the grid layout will exceed the
-    // bounding box if more than 18 nodes are provided.
+    // A 3-column grid only fits 18 nodes in the 100 m x 100 m walk bounds, so
+    // larger runs switch to a square grid and grow the bounds to cover it.
+    uint32_t gridWidth = 3;
+    double bound = 50.0;
     if (nWifi > 18)
     {
-        std::cout << "nWifi should be 18 or less; otherwise grid layout exceeds the bounding box"
-                  << std::endl;
-        return 1;
+        gridWidth = std::ceil(std::sqrt(nWifi));
+        double gridRows = std::ceil(static_cast<double>(nWifi) / gridWidth);
+        bound = std::max({bound, (gridWidth - 1) * 5.0, (gridRows - 1) * 10.0});
     }
 
     if (verbose)
@@ -104,6 +114,16 @@ main(int argc, char* argv[])
     NodeContainer wifiApNode = p2pNodes.Get(0);
 
     YansWifiChannelHelper channel = YansWifiChannelHelper::Default();
+    // A modeling knob, not a speed-up: YansWifiChannel still schedules a
+    // Receive event (with a packet copy) at every PHY, and a signal beyond
+    // MaxRange merely arrives at -1000 dBm and is discarded there, as a weak
+    // LogDistance signal already is at the RxSensitivity check.
+    if (maxRange > 0)
+    {
+        channel.AddPropagationLoss("ns3::RangePropagationLossModel",
+                                   "MaxRange",
+                                   DoubleValue(maxRange));
+    }
     YansWifiPhyHelper phy;
     phy.SetChannel(channel.Create());
 
@@ -132,14 +152,17 @@ main(int argc, char* argv[])
                                   "DeltaY",
                                   DoubleValue(10.0),
                                   "GridWidth",
-                                  UintegerValue(3),
+                                  UintegerValue(gridWidth),
                                   "LayoutType",
                                   StringValue("RowFirst"));
 
     mobility.SetMobilityModel("ns3::RandomWalk2dMobilityModel",
                               "Bounds",
-                              RectangleValue(Rectangle(-50, 50, -50, 50)));
+                              RectangleValue(Rectangle(-bound, bound, -bound, bound)));
     mobility.Install(wifiStaNodes);
+    // Fixed streams for the walk's direction and speed draws, so STA paths depend
+    // only on the seed and run number.
+    mobility.AssignStreams(wifiStaNodes, 0);
 
     mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
     mobility.Install(wifiApNode);
@@ -159,7 +182,17 @@ main(int argc, char* argv[])
     Ipv4InterfaceContainer csmaInterfaces;
     csmaInterfaces = address.Assign(csmaDevices);
 
-    address.SetBase("10.1.3.0", "255.255.255.0");
+    // A /24 holds 253 STAs plus the AP; larger runs move the wifi subnet to a
+    // /16 that does not overlap the 10.1.x.0 networks. ApWifiMac hands out at
+    // most 2007 association IDs, so STAs beyond that never associate.
+    if (nWifi > 253)
+    {
+        address.SetBase("10.3.0.0", "255.255.0.0");
+    }
+    else
+    {
+        address.SetBase("10.1.3.0", "255.255.255.0");
+    }
     address.Assign(staDevices);
     address.Assign(apDevices);
 
@@ -174,7 +207,27 @@ main(int argc, char* argv[])
     echoClient.SetAttribute("Interval", TimeValue(Seconds(1.0)));
     echoClient.SetAttribute("PacketSize", UintegerValue(1024));
 
-    ApplicationContainer clientApps = echoClient.Install(wifiStaNodes.Get(nWifi - 1));
+    // On a large grid the last STA can start far outside the AP's range, so
+    // the client goes on the STA that starts closest to the AP instead.
+    uint32_t clientSta = nWifi - 1;
+    if (nWifi > 18)
+    {
+        Vector apPosition = wifiApNode.Get(0)->GetObject<MobilityModel>()->GetPosition();
+        double nearest = CalculateDistance(wifiStaNodes.Get(clientSta)->GetObject<MobilityModel>()->GetPosition(),
+                                           apPosition);
+        for (uint32_t i = 0; i < nWifi; i++)
+        {
+            double distance =
+                CalculateDistance(wifiStaNodes.Get(i)->GetObject<MobilityModel>()->GetPosition(), apPosition);
+            if (distance < nearest)
+            {
+                nearest = distance;
+                clientSta = i;
+            }
+        }
+    }
+
+    ApplicationContainer clientApps = echoClient.Install(wifiStaNodes.Get(clientSta));
     clientApps.Start(Seconds(2.0));
     clientApps.Stop(Seconds(10.0));
 
@@ -185,17 +238,29 @@ main(int argc, char* argv[])
     if (tracing)
     {
         phy.SetPcapDataLinkType(WifiPhyHelper::DLT_IEEE802_11_RADIO);
-        pointToPoint.EnablePcapAll("third");
+        PcapHelper pcapHelper;
+        Ptr<PcapFileWrapper> p2pFile =
+            pcapHelper.CreateFile("third-p2p.pcap", std::ios::out, PcapHelper::DLT_PPP, snapLen);
+        for (uint32_t i = 0; i < p2pDevices.GetN(); i++)
+        {
+            Ptr<PointToPointNetDevice> device = StaticCast<PointToPointNetDevice>(p2pDevices.Get(i));
+            pcapHelper.HookDefaultSink<PointToPointNetDevice>(device, "PhyTxBegin", p2pFile);
+        }
         phy.EnablePcap("third", apDevices.Get(0));
         csma.EnablePcap("third", csmaDevices.Get(0), true);
     }
 
-    std::ostringstream oss;
-    oss <<
-        "/NodeList/" << wifiStaNodes.Get(nWifi - 1)->GetId() <<
-        "/$ns3::MobilityModel/CourseChange";
+    // CourseChange fires on every walk step; leave it unconnected for large runs
+    // so no formatting or logging work is done per step.
+    if (traceMobility)
+    {
+        std::ostringstream oss;
+        oss <<
+            "/NodeList/" << wifiStaNodes.Get(clientSta)->GetId() <<
+            "/$ns3::MobilityModel/CourseChange";
 
-    Config::Connect(oss.str(), MakeCallback(&CourseChange));
+        Config::Connect(oss.str(), MakeCallback(&CourseChange));
+    }
 
     Simulator::Run();
     Simulator::Destroy();
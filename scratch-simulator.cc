@@ -15,17 +15,58 @@
 
 #include "ns3/core-module.h"
 
+#include <chrono>
+#include <iostream>
+
+#include <sys/resource.h>
+
+// Startup benchmark: an empty simulation, so the cost measured is loading the
+// ns-3 libraries and their static initialization (TypeIds, attributes, trace
+// sources, log components).
+
 using namespace ns3;
 
 NS_LOG_COMPONENT_DEFINE("ScratchSimulator");
 
+// CPU time used by the process so far, in milliseconds.
+static double
+CpuTimeMs()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1e3 +
+           (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e3;
+}
+
 int
 main(int argc, char* argv[])
 {
+    // Taken before anything else so it only covers what ran ahead of main().
+    double startupMs = CpuTimeMs();
+    double targetMs = 0;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("targetMs", "Fail if startup CPU time exceeds this many milliseconds (0 = report only)", targetMs);
+    cmd.Parse(argc, argv);
+
     NS_LOG_UNCOND("Scratch Simulator");
 
+    auto runStart = std::chrono::steady_clock::now();
     Simulator::Run();
     Simulator::Destroy();
+    double runMs =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - runStart)
+            .count();
+
+    std::cout << "startup (cpu): " << startupMs << " ms" << std::endl;
+    std::cout << "registered TypeIds: " << TypeId::GetRegisteredN() << std::endl;
+    std::cout << "run + destroy: " << runMs << " ms" << std::endl;
+
+    if (targetMs > 0 && startupMs > targetMs)
+    {
+        std::cout << "startup exceeds the " << targetMs << " ms target" << std::endl;
+        return 1;
+    }
 
     return 0;
 }
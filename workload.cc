@@ -0,0 +1,476 @@
+#include "ns3/applications-module.h"
+#include "ns3/core-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/network-module.h"
+#include "ns3/point-to-point-layout-module.h"
+#include "ns3/point-to-point-module.h"
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+/*
+   Network Topology
+   N0 ---+            +--- N(n)
+         |            |
+   .. ---R1 -------- R2--- ..
+         |            |
+   N(n-1)+            +--- N(2n-1)
+
+   Each left node runs one FlowGenerator that opens flows towards its right
+   peer: Poisson arrivals, sizes drawn from an empirical CDF, and a bounded
+   pool of TCP connections that are reused between flows.
+*/
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("Workload");
+
+// Drives many short TCP flows from a single application. Memory per node is
+// fixed: at most MaxConnections sockets, a bounded backlog of flows waiting
+// for a free connection, and a log2 histogram of flow completion times.
+class FlowGenerator : public Application
+{
+  public:
+    static TypeId GetTypeId();
+
+    FlowGenerator();
+    ~FlowGenerator() override;
+
+    void Setup(Address peer, double flowRate, Ptr<EmpiricalRandomVariable> flowSize);
+    void PrintStats(std::ostream& os) const;
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    // A pooled connection; socket is null while the slot is unused.
+    struct Connection
+    {
+        Ptr<Socket> socket;
+        uint32_t sndBufSize = 0;
+        bool connected = false;
+        bool busy = false;
+        uint64_t toWrite = 0;
+        Time start;
+    };
+
+    // A flow waiting for a free connection; its FCT counts from arrival.
+    struct PendingFlow
+    {
+        uint32_t size;
+        Time arrival;
+    };
+
+    void StartApplication() override;
+    void StopApplication() override;
+
+    void FlowArrival();
+    void StartFlow(Connection* connection, uint32_t size, Time arrival);
+    void OpenConnection(Connection* connection, uint32_t size);
+    void ConnectionSucceeded(Ptr<Socket> socket);
+    void ConnectionFailed(Ptr<Socket> socket);
+    void SendData(Ptr<Socket> socket, uint32_t available);
+    void FlowCompleted(Connection* connection);
+    Connection* Find(Ptr<Socket> socket);
+
+    static const uint32_t HISTOGRAM_BUCKETS = 32;
+    static const uint32_t MAX_BACKLOG = 1024;
+    static const uint32_t MAX_CHUNK = 65536;
+
+    Address m_peer;
+    uint32_t m_maxConnections;
+    Ptr<ExponentialRandomVariable> m_interArrival;
+    Ptr<EmpiricalRandomVariable> m_flowSize;
+    std::vector<Connection> m_connections;
+    std::deque<PendingFlow> m_backlog;
+    EventId m_arrivalEvent;
+
+    uint64_t m_flowsStarted;
+    uint64_t m_flowsCompleted;
+    uint64_t m_flowsRejected;
+    uint64_t m_connectionsOpened;
+    double m_fctSum;
+    double m_fctMax;
+    uint64_t m_fctHistogram[HISTOGRAM_BUCKETS]; // bucket b: FCT in [2^b, 2^(b+1)) us
+};
+
+NS_OBJECT_ENSURE_REGISTERED(FlowGenerator);
+
+TypeId
+FlowGenerator::GetTypeId()
+{
+    static TypeId tid = TypeId("FlowGenerator")
+                            .SetParent<Application>()
+                            .SetGroupName("Tutorial")
+                            .AddConstructor<FlowGenerator>()
+                            .AddAttribute("MaxConnections",
+                                          "Upper bound on concurrently open TCP connections",
+                                          UintegerValue(16),
+                                          MakeUintegerAccessor(&FlowGenerator::m_maxConnections),
+                                          MakeUintegerChecker<uint32_t>(1));
+    return tid;
+}
+
+FlowGenerator::FlowGenerator()
+    : m_flowsStarted(0),
+      m_flowsCompleted(0),
+      m_flowsRejected(0),
+      m_connectionsOpened(0),
+      m_fctSum(0),
+      m_fctMax(0)
+{
+    std::fill(m_fctHistogram, m_fctHistogram + HISTOGRAM_BUCKETS, 0);
+}
+
+FlowGenerator::~FlowGenerator()
+{
+    m_connections.clear();
+}
+
+void
+FlowGenerator::Setup(Address peer, double flowRate, Ptr<EmpiricalRandomVariable> flowSize)
+{
+    m_peer = peer;
+    m_interArrival = CreateObject<ExponentialRandomVariable>();
+    m_interArrival->SetAttribute("Mean", DoubleValue(1.0 / flowRate));
+    m_flowSize = flowSize;
+}
+
+void
+FlowGenerator::DoDispose()
+{
+    m_connections.clear();
+    m_backlog.clear();
+    m_interArrival = nullptr;
+    m_flowSize = nullptr;
+    Application::DoDispose();
+}
+
+void
+FlowGenerator::StartApplication()
+{
+    // Connection pointers are handed around, so the pool never reallocates.
+    m_connections.resize(m_maxConnections);
+    m_arrivalEvent = Simulator::Schedule(Seconds(m_interArrival->GetValue()), &FlowGenerator::FlowArrival, this);
+}
+
+void
+FlowGenerator::StopApplication()
+{
+    Simulator::Cancel(m_arrivalEvent);
+    for (Connection& connection : m_connections)
+    {
+        if (connection.socket)
+        {
+            connection.socket->Close();
+            connection.socket = nullptr;
+        }
+    }
+    m_backlog.clear();
+}
+
+void
+FlowGenerator::FlowArrival()
+{
+    uint32_t size = std::max(1.0, std::round(m_flowSize->GetValue()));
+    m_flowsStarted++;
+
+    m_arrivalEvent = Simulator::Schedule(Seconds(m_interArrival->GetValue()), &FlowGenerator::FlowArrival, this);
+
+    // Prefer an idle open connection, then an unused slot; otherwise the flow
+    // waits for the next connection to finish, unless the backlog is full.
+    Connection* unused = nullptr;
+    for (Connection& connection : m_connections)
+    {
+        if (connection.socket && connection.connected && !connection.busy)
+        {
+            StartFlow(&connection, size, Simulator::Now());
+            return;
+        }
+        if (!connection.socket && !unused)
+        {
+            unused = &connection;
+        }
+    }
+
+    if (unused)
+    {
+        OpenConnection(unused, size);
+    }
+    else if (m_backlog.size() < MAX_BACKLOG)
+    {
+        m_backlog.push_back({size, Simulator::Now()});
+    }
+    else
+    {
+        m_flowsRejected++;
+    }
+}
+
+void
+FlowGenerator::StartFlow(Connection* connection, uint32_t size, Time arrival)
+{
+    connection->busy = true;
+    connection->toWrite = size;
+    connection->start = arrival;
+    SendData(connection->socket, connection->socket->GetTxAvailable());
+}
+
+void
+FlowGenerator::OpenConnection(Connection* connection, uint32_t size)
+{
+    connection->socket = Socket::CreateSocket(GetNode(), TcpSocketFactory::GetTypeId());
+    UintegerValue sndBufSize;
+    connection->socket->GetAttribute("SndBufSize", sndBufSize);
+    connection->sndBufSize = sndBufSize.Get();
+    connection->connected = false;
+    connection->busy = true;
+    connection->toWrite = size;
+    connection->start = Simulator::Now();
+    m_connectionsOpened++;
+
+    connection->socket->Bind();
+    connection->socket->Connect(m_peer);
+    connection->socket->SetConnectCallback(MakeCallback(&FlowGenerator::ConnectionSucceeded, this),
+                                           MakeCallback(&FlowGenerator::ConnectionFailed, this));
+    connection->socket->SetSendCallback(MakeCallback(&FlowGenerator::SendData, this));
+}
+
+void
+FlowGenerator::ConnectionSucceeded(Ptr<Socket> socket)
+{
+    Connection* connection = Find(socket);
+    if (!connection)
+    {
+        return;
+    }
+    connection->connected = true;
+    SendData(socket, socket->GetTxAvailable());
+}
+
+void
+FlowGenerator::ConnectionFailed(Ptr<Socket> socket)
+{
+    Connection* connection = Find(socket);
+    if (!connection)
+    {
+        return;
+    }
+    NS_LOG_WARN("connection to the sink failed; dropping its flow");
+    m_flowsRejected++;
+    connection->socket = nullptr;
+    connection->busy = false;
+}
+
+// Writes as much of the current flow as the send buffer takes. The flow is
+// complete once everything was written and the buffer is empty again, i.e.
+// every byte has been acknowledged.
+void
+FlowGenerator::SendData(Ptr<Socket> socket, uint32_t available)
+{
+    Connection* connection = Find(socket);
+    if (!connection || !connection->connected || !connection->busy)
+    {
+        return;
+    }
+
+    while (connection->toWrite > 0 && socket->GetTxAvailable() > 0)
+    {
+        uint32_t chunk = std::min<uint64_t>({connection->toWrite, socket->GetTxAvailable(), MAX_CHUNK});
+        int sent = socket->Send(Create<Packet>(chunk));
+        if (sent <= 0)
+        {
+            break;
+        }
+        connection->toWrite -= sent;
+    }
+
+    if (connection->toWrite == 0 && socket->GetTxAvailable() == connection->sndBufSize)
+    {
+        FlowCompleted(connection);
+    }
+}
+
+void
+FlowGenerator::FlowCompleted(Connection* connection)
+{
+    double fct = (Simulator::Now() - connection->start).GetSeconds();
+    m_flowsCompleted++;
+    m_fctSum += fct;
+    m_fctMax = std::max(m_fctMax, fct);
+    uint32_t bucket = fct * 1e6 < 1 ? 0 : std::log2(fct * 1e6);
+    m_fctHistogram[std::min(bucket, HISTOGRAM_BUCKETS - 1)]++;
+
+    connection->busy = false;
+    if (!m_backlog.empty())
+    {
+        PendingFlow flow = m_backlog.front();
+        m_backlog.pop_front();
+        StartFlow(connection, flow.size, flow.arrival);
+    }
+}
+
+FlowGenerator::Connection*
+FlowGenerator::Find(Ptr<Socket> socket)
+{
+    for (Connection& connection : m_connections)
+    {
+        if (connection.socket == socket)
+        {
+            return &connection;
+        }
+    }
+    return nullptr;
+}
+
+void
+FlowGenerator::PrintStats(std::ostream& os) const
+{
+    os << "flows " << m_flowsStarted << " started, " << m_flowsCompleted << " completed, "
+       << m_flowsRejected << " rejected; " << m_connectionsOpened << " connections opened" << std::endl;
+    if (m_flowsCompleted == 0)
+    {
+        return;
+    }
+
+    // Percentiles are reported as the upper edge of their histogram bucket.
+    uint64_t p50 = 0, p99 = 0, seen = 0;
+    for (uint32_t b = 0; b < HISTOGRAM_BUCKETS; b++)
+    {
+        seen += m_fctHistogram[b];
+        if (!p50 && seen * 2 >= m_flowsCompleted)
+        {
+            p50 = 1ULL << (b + 1);
+        }
+        if (!p99 && seen * 100 >= m_flowsCompleted * 99)
+        {
+            p99 = 1ULL << (b + 1);
+        }
+    }
+    os << "FCT mean " << m_fctSum / m_flowsCompleted * 1e3 << " ms, max " << m_fctMax * 1e3
+       << " ms, p50 < " << p50 / 1e3 << " ms, p99 < " << p99 / 1e3 << " ms" << std::endl;
+}
+
+// Web search flow sizes (pFabric), in 1460-byte packets.
+const double WEB_SEARCH_CDF[][2] = {
+    {1, 0},
+    {6, 0.15},
+    {13, 0.2},
+    {19, 0.3},
+    {33, 0.4},
+    {53, 0.53},
+    {133, 0.6},
+    {667, 0.7},
+    {1333, 0.8},
+    {3333, 0.9},
+    {6667, 0.97},
+    {20000, 1.0},
+};
+
+// Reads "<size in bytes> <cumulative probability>" lines, or falls back to
+// the web search CDF when no file is given.
+Ptr<EmpiricalRandomVariable>
+MakeFlowSizeDistribution(std::string cdfFile)
+{
+    Ptr<EmpiricalRandomVariable> flowSize = CreateObject<EmpiricalRandomVariable>();
+    // Sample sizes between the breakpoints rather than only the breakpoints.
+    flowSize->SetInterpolate(true);
+    if (cdfFile.empty())
+    {
+        for (const auto& point : WEB_SEARCH_CDF)
+        {
+            flowSize->CDF(point[0] * 1460, point[1]);
+        }
+        return flowSize;
+    }
+
+    std::ifstream in(cdfFile);
+    NS_ABORT_MSG_IF(!in, "cannot open " << cdfFile);
+    double size, probability;
+    while (in >> size >> probability)
+    {
+        flowSize->CDF(size, probability);
+    }
+    return flowSize;
+}
+
+int
+main(int argc, char* argv[])
+{
+    int nLeaf = 10;
+    int operationTime = 10;
+    double flowRate = 1.5;
+    uint32_t maxConnections = 16;
+    std::string cdfFile = "";
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("nLeaf", "number of sender/receiver pairs", nLeaf);
+    cmd.AddValue("operationTime", "time value where application sends packet in second", operationTime);
+    cmd.AddValue("flowRate",
+                 "Poisson flow arrivals per second per sender; the web search CDF averages 1.66 MB, so "
+                 "1.5 offers 20 Mb/s per 100 Mb/s access link and, with 10 senders, 0.67 load on the "
+                 "300 Mb/s bottleneck",
+                 flowRate);
+    cmd.AddValue("maxConnections", "TCP connections each sender keeps open at most", maxConnections);
+    cmd.AddValue("cdf", "flow size CDF file (\"<bytes> <probability>\" per line); web search if empty", cdfFile);
+    cmd.Parse(argc, argv);
+
+    Time::SetResolution(Time::NS);
+
+    PointToPointHelper gateway;
+    gateway.SetDeviceAttribute("DataRate", StringValue("100Mbps"));
+    gateway.SetChannelAttribute("Delay", StringValue("2ms"));
+    gateway.DisableFlowControl();
+
+    PointToPointHelper bottleneck;
+    bottleneck.SetDeviceAttribute("DataRate", StringValue("300Mbps"));
+    bottleneck.SetChannelAttribute("Delay", StringValue("10ms"));
+    bottleneck.DisableFlowControl();
+
+    PointToPointDumbbellHelper d(nLeaf, gateway, nLeaf, gateway, bottleneck);
+
+    InternetStackHelper stack;
+    d.InstallStack(stack);
+
+    d.AssignIpv4Addresses(Ipv4AddressHelper("10.1.1.0", "255.255.255.0"),
+                          Ipv4AddressHelper("10.2.1.0", "255.255.255.0"),
+                          Ipv4AddressHelper("10.3.1.0", "255.255.255.0"));
+
+    Ptr<EmpiricalRandomVariable> flowSize = MakeFlowSizeDistribution(cdfFile);
+
+    uint16_t sinkPort = 8080;
+    PacketSinkHelper packetSinkHelper("ns3::TcpSocketFactory", InetSocketAddress(Ipv4Address::GetAny(), sinkPort));
+    std::vector<Ptr<FlowGenerator>> generators;
+    for (int i = 0; i < nLeaf; i++)
+    {
+        ApplicationContainer sinkApps = packetSinkHelper.Install(d.GetRight(i));
+        sinkApps.Start(Seconds(1.0));
+        sinkApps.Stop(Seconds(operationTime + 2.0));
+
+        Ptr<FlowGenerator> generator = CreateObject<FlowGenerator>();
+        generator->SetAttribute("MaxConnections", UintegerValue(maxConnections));
+        generator->Setup(InetSocketAddress(d.GetRightIpv4Address(i), sinkPort), flowRate, flowSize);
+        d.GetLeft(i)->AddApplication(generator);
+        generator->SetStartTime(Seconds(1.0));
+        generator->SetStopTime(Seconds(operationTime + 1.0));
+        generators.push_back(generator);
+    }
+
+    Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+
+    Simulator::Stop(Seconds(operationTime + 2.0));
+    Simulator::Run();
+
+    for (int i = 0; i < nLeaf; i++)
+    {
+        std::cout << "N" << i << ": ";
+        generators[i]->PrintStats(std::cout);
+    }
+
+    Simulator::Destroy();
+    return 0;
+}